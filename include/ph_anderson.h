@@ -18,8 +18,34 @@ typedef struct {
     int max_size;       /* 最大历史大小 */
 } AndersonInfo;
 
+#define TOL_ANDERSON_QR 1.0e-10       /* QR对角元相对阈值（低于此值丢弃最旧列） */
+
+/**
+ * @brief Anderson加速器实例状态（由调用方持有）
+ *
+ * 历史以MAX_ANDERSON_HISTORY x NC环形缓冲区存储在固定大小的数组中，不使用全局状态，
+ * 每个线程/每次闪蒸使用独立实例即可并行计算。残差差分矩阵dF的薄QR分解随每次
+ * 更新增量维护：新列以修正Gram-Schmidt追加，最旧列以Givens旋转删除，
+ * 每次更新的计算量为O(m·NC)，不再求解法方程。
+ */
+typedef struct {
+    double dx_history[MAX_ANDERSON_HISTORY][NC]; /* 解向量差分历史（环形） */
+    double df_history[MAX_ANDERSON_HISTORY][NC]; /* 残差向量差分历史（环形） */
+    double Q[MAX_ANDERSON_HISTORY][NC];          /* dF的QR分解正交因子（按列存储） */
+    double R[MAX_ANDERSON_HISTORY][MAX_ANDERSON_HISTORY]; /* dF的QR分解上三角因子 */
+    double x_prev[NC];  /* 上一次的解向量 */
+    double f_prev[NC];  /* 上一次的残差向量 */
+    int has_prev;       /* x_prev/f_prev是否有效 */
+    int head;           /* 最旧历史在环形缓冲区中的位置 */
+    int initialized;    /* 是否已初始化 */
+    int iter_count;     /* 迭代计数 */
+    int current_size;   /* 当前历史大小 */
+    int max_size;       /* 最大历史大小（不超过MAX_ANDERSON_HISTORY） */
+} AndersonState;
+
 /**
  * @brief 初始化Anderson加速器
+ * @note 基于进程内共享的默认实例，非线程安全；多线程请使用ph_anderson_state_*接口
  * @param max_depth 最大混合深度（建议3-5）
  * @return 错误代码
  */
@@ -46,4 +72,37 @@ PHErrorCode ph_anderson_update(const double *x_current, const double *f_current,
  */
 void ph_anderson_get_info(AndersonInfo *info);
 
+/**
+ * @brief 初始化调用方持有的Anderson加速器实例
+ * @param state Anderson加速器实例
+ * @param max_depth 最大混合深度（建议3-5，不超过MAX_ANDERSON_HISTORY）
+ * @return 错误代码
+ */
+PHErrorCode ph_anderson_state_init(AndersonState *state, int max_depth);
+
+/**
+ * @brief 清空Anderson加速器实例的历史（保留最大深度设置）
+ * @param state Anderson加速器实例
+ */
+void ph_anderson_state_reset(AndersonState *state);
+
+/**
+ * @brief 使用指定实例进行Anderson混合加速更新
+ * @note R的对角元相对最大值低于TOL_ANDERSON_QR时丢弃最旧列以保持良态
+ * @param state Anderson加速器实例
+ * @param x_current 当前解向量 [NC]
+ * @param f_current 当前残差向量 [NC]
+ * @param x_new 输出的加速解向量 [NC]
+ * @return 错误代码
+ */
+PHErrorCode ph_anderson_state_update(AndersonState *state, const double *x_current,
+                                    const double *f_current, double *x_new);
+
+/**
+ * @brief 获取指定Anderson加速器实例的状态信息
+ * @param state Anderson加速器实例
+ * @param info 输出状态信息结构
+ */
+void ph_anderson_state_get_info(const AndersonState *state, AndersonInfo *info);
+
 #endif /* PH_ANDERSON_H */
\ No newline at end of file
@@ -29,6 +29,9 @@
 #define MAX_ITER_ANDERSON 10          /* Anderson加速最大迭代次数 */
 #define MAX_TPD_TRIALS 7              /* TPD分析最大试探点数 */
 #define MAX_ANDERSON_HISTORY 5        /* Anderson加速历史存储数量 */
+#define MAX_ITER_NEWTON 30            /* 联立Newton求解最大迭代次数 */
+#define MAX_ITER_IO_OUTER 20          /* inside-out外循环（严格模型更新）最大迭代次数 */
+#define MAX_ITER_VLE_NEWTON 20        /* VLE二阶(ln K Newton)阶段最大迭代次数 */
 
 /**
  * @brief 容差设置
@@ -40,6 +43,12 @@
 #define TOL_RR 1.0e-10               /* Rachford-Rice方程容差 */
 #define TOL_TPD 1.0e-8                /* TPD稳定性判据容差 */
 #define TOL_FUGACITY 1.0e-7          /* 逸度平衡容差 */
+#define TOL_VLE_NEWTON_SWITCH 1.0e-3 /* 逐次替代切换到Newton的残差阈值 */
+#define TOL_STABILITY_BETA 1.0e-3    /* 两相状态下beta接近0/1时重新进行稳定性分析的阈值 */
+#define TOL_STABILITY_TPD_MARGIN 1.0e-3 /* 单相状态下跳过稳定性分析所需的最小TPD裕量 */
+#define TOL_STABILITY_TPD_SLOPE 1.0e-2  /* 估计TPD温度变化率时采用的最小速率 [1/K] */
+#define TOL_WARM_START_COMPOSITION 1.0e-6 /* 热启动允许的进料组成最大绝对偏差 */
+#define TOL_NEGATIVE_FLASH_BETA 1.0e-2  /* 负闪蒸beta与0或1的距离小于该值时视为靠近相包络 */
 
 /**
  * @brief 自适应容差设置
@@ -64,6 +73,19 @@ typedef enum {
 #define BIP_UNISIM          1         /* UniSim数据 */
 #define BIP_CUSTOM          2         /* 自定义值 */
 
+/**
+ * @brief 闪蒸求解引擎常量
+ */
+#define FLASH_ENGINE_NESTED       0   /* 温度外循环嵌套等温闪蒸（默认） */
+#define FLASH_ENGINE_NEWTON       1   /* (T, ln K, beta)联立Newton求解 */
+#define FLASH_ENGINE_INSIDE_OUT   2   /* Boston-Britt inside-out求解 */
+
+/**
+ * @brief Rachford-Rice求解器常量
+ */
+#define RR_SOLVER_NEWTON          0   /* 阻尼Newton（默认） */
+#define RR_SOLVER_CONVEX          1   /* Leibovici-Nichita凸变换 + Halley（带区间保护） */
+
 /**
  * @brief 组分索引
  */
@@ -74,6 +96,18 @@ typedef enum {
 #define IDX_NH3 3                     /* NH3索引 */
 #define IDX_H2O 4                     /* H2O索引 */
 
+/**
+ * @brief 向量化数据布局
+ */
+#define PH_SIMD_ALIGNMENT 64          /* 向量化数组对齐字节数（一个缓存行） */
+#define PH_NC_PADDED 8                /* 组分维度填充后长度（一个AVX-512或两个AVX2寄存器） */
+
+#if defined(_MSC_VER)
+#define PH_ALIGNED(n) __declspec(align(n))
+#else
+#define PH_ALIGNED(n) __attribute__((aligned(n)))
+#endif
+
 /**
  * @brief 相类型枚举
  */
@@ -125,11 +159,16 @@ typedef struct {
     double phi_L[NC];   /* 液相逸度系数 */
     double phi_V[NC];   /* 气相逸度系数 */
     int iterations;     /* 所需迭代次数 */
+    int vle_ss_iterations;     /* 最后一次等温闪蒸的逐次替代迭代次数 */
+    int vle_newton_iterations; /* 最后一次等温闪蒸的Newton迭代次数 */
     PHErrorCode status; /* 状态代码 */
 } StateProperties;
 
 /**
  * @brief PR状态方程参数
+ *
+ * a_ij缓存按PH_NC_PADDED填充并按PH_SIMD_ALIGNMENT对齐（填充项为0），向量化逸度
+ * 核函数直接读取，不再逐次打包；因此堆上分配须使用ph_malloc_aligned。
  */
 typedef struct {
     double a_pure[NC];         /* 纯组分'a'参数 */
@@ -140,8 +179,106 @@ typedef struct {
     double da_dT;              /* a_mix的温度导数 */
     double Tc_used[NC];        /* 实际使用的临界温度（含量子修正） [K] */
     double Pc_used[NC];        /* 实际使用的临界压力（含量子修正） [Pa] */
+    double T_pure;             /* a_pure、b_pure、Tc_used、Pc_used对应的温度 [K] */
+    int use_quantum_h2;        /* 是否对H2使用量子修正（由options复制） */
+
+    int bip_source;            /* 生成kij的BIP来源(BIP_RECOMMENDED/BIP_UNISIM/BIP_CUSTOM) */
+    unsigned int bip_version;  /* kij修改计数（ph_eos_set_kij递增） */
+
+    /* 温度相关的a_ij缓存（两相及线搜索试探点在同一温度下共用） */
+    PH_ALIGNED(PH_SIMD_ALIGNMENT) double aij[PH_NC_PADDED][PH_NC_PADDED];     /* sqrt(a_i a_j)(1-k_ij) */
+    PH_ALIGNED(PH_SIMD_ALIGNMENT) double daij_dT[PH_NC_PADDED][PH_NC_PADDED]; /* a_ij的温度导数 */
+    PH_ALIGNED(PH_SIMD_ALIGNMENT) double d2aij_dT2[PH_NC_PADDED][PH_NC_PADDED]; /* a_ij的温度二阶导数 */
+    PH_ALIGNED(PH_SIMD_ALIGNMENT) double b_padded[PH_NC_PADDED];              /* 填充后的纯组分'b'参数 */
+    double aij_cache_T;        /* 缓存对应的温度 [K] */
+    int aij_cache_bip_source;  /* 缓存对应的BIP来源 */
+    unsigned int aij_cache_bip_version; /* 缓存对应的kij修改计数 */
+    int aij_cache_valid;       /* 缓存是否有效 */
 } PREOSParams;
 
+/**
+ * @brief 闪蒸计算阶段（用于分阶段计时）
+ */
+typedef enum {
+    PH_STAGE_SETUP = 0,               /* 初始化（临界性质、焓模型、BIP） */
+    PH_STAGE_INIT_TEMP = 1,           /* 初始温度估计 */
+    PH_STAGE_VLE = 2,                 /* 等温闪蒸（不含RR和TPD） */
+    PH_STAGE_RACHFORD_RICE = 3,       /* Rachford-Rice求解 */
+    PH_STAGE_TPD = 4,                 /* TPD稳定性分析 */
+    PH_STAGE_ENTHALPY = 5,            /* 焓及焓导数计算 */
+    PH_STAGE_LINE_SEARCH = 6,         /* 线搜索 */
+    PH_STAGE_COUNT = 7                /* 阶段数 */
+} PHFlashStage;
+
+/**
+ * @brief 闪蒸性能计数（单次闪蒸输出或上下文累计）
+ */
+typedef struct {
+    long flashes;                 /* 计入的闪蒸次数 */
+    long outer_iterations;        /* 温度外循环迭代次数 */
+    long vle_iterations;          /* 等温闪蒸内循环迭代次数 */
+    long rr_iterations;           /* Rachford-Rice迭代次数 */
+    long tpd_trials;              /* TPD试探组成数 */
+    long cubic_solves;            /* 三次方程求解次数 */
+    long fugacity_evals;          /* 逸度系数计算次数 */
+    long enthalpy_evals;          /* 焓计算次数 */
+    long line_search_backtracks;  /* 线搜索回退次数 */
+    long anderson_accepted;       /* Anderson加速步接受次数 */
+    long anderson_rejected;       /* Anderson加速步拒绝次数 */
+    double stage_time[PH_STAGE_COUNT]; /* 各阶段耗时（CLOCK_MONOTONIC） [s] */
+    double total_time;            /* 总耗时 [s] */
+} PHFlashStats;
+
+/*
+ * 当前线程的性能计数接收者
+ * ph_eos_*、ph_enthalpy_*、ph_vle_*和ph_flash_temperature_iteration不带stats参数，
+ * 通过PH_STATS_ADD把计数写入本线程的g_flash_stats_current；为NULL（默认）时
+ * 不计数、不读取时钟。由ph_flash_stats_set_current设置。
+ */
+extern PH_THREAD_LOCAL PHFlashStats* g_flash_stats_current;
+
+#define PH_STATS_ADD(field, n) \
+    do { \
+        if (g_flash_stats_current != NULL) { \
+            g_flash_stats_current->field += (n); \
+        } \
+    } while(0)
+
+/**
+ * @brief 迭代追踪事件来源
+ */
+typedef enum {
+    PH_TRACE_OUTER = 0,               /* ph_flash_temperature_iteration温度外循环 */
+    PH_TRACE_VLE = 1                  /* ph_vle_isothermal_flash内循环 */
+} PHTraceSource;
+
+/**
+ * @brief 迭代追踪事件
+ */
+typedef struct {
+    PHTraceSource source;      /* 事件来源 */
+    int iteration;             /* 迭代次数 */
+    double T;                  /* 温度 [K] */
+    double H_error;            /* 焓误差 [J/mol]（内循环为0） */
+    double beta;               /* 气相摩尔分数 */
+    double K_residual;         /* K值最大相对变化 */
+    double damping;            /* 阻尼因子 */
+    int anderson_status;       /* Anderson状态(0=未使用, 1=接受, -1=拒绝) */
+} PHTraceEvent;
+
+/**
+ * @brief 迭代追踪回调函数
+ *
+ * 回调在执行闪蒸的线程中同步调用。多个线程使用同一份FlashOptions时
+ * （包括ph_parallel_pool_create复制到每个工作线程的选项），回调会被并发调用
+ * 且收到同一个user_data，回调及user_data须自行保证线程安全；需要每个线程
+ * 独立的user_data时使用ph_parallel_pool_set_trace_user_data。
+ *
+ * @param event 追踪事件（仅在回调期间有效）
+ * @param user_data 用户数据
+ */
+typedef void (*PHTraceCallback)(const PHTraceEvent *event, void *user_data);
+
 /**
  * @brief 闪蒸计算参数
  */
@@ -152,7 +289,6 @@ typedef struct {
     int eos_type;              /* 0=PR, 1=PR-CPA */
     int use_anderson;          /* 是否使用Anderson加速 */
     int use_line_search;       /* 是否使用线搜索保护机制 */
-    int verbose;               /* 详细输出标志 */
     double damping;            /* 初始阻尼因子 */
     double tol_factor;         /* 困难案例的容差乘数 */
     int use_adaptive_tolerance; /* 是否使用自适应容差 */
@@ -164,8 +300,53 @@ typedef struct {
     double derivative_perturbation; /* 焓导数温度扰动 [K] (0=自动) */
     int use_analytical_backup;  /* 数值失败时是否使用解析备用 */
     double max_reasonable_dhdt; /* 合理dH/dT上限 [J/(mol·K)] */
+    int use_analytical_derivative; /* 两相状态是否使用解析dH/dT（不再扰动温度重算VLE） */
+    int flash_engine;           /* 求解引擎(0=嵌套, 1=联立Newton, 2=inside-out) */
+    int use_vle_newton;         /* 等温闪蒸是否在逐次替代后切换到ln K Newton */
+    double vle_newton_switch_tol; /* 切换阈值（逐次替代残差，0=TOL_VLE_NEWTON_SWITCH） */
+    int use_stability_skip;     /* 温度迭代间是否复用上次稳定性分析结果 */
+    int use_adaptive_tpd_order; /* 上下文闪蒸是否按试探成功率排序TPD试探组成（结果不再逐位确定） */
+    int use_negative_flash;     /* 等温闪蒸是否使用负闪蒸（beta可超出[0,1]）判定相数 */
+    int rr_solver;              /* Rachford-Rice求解器(0=Newton, 1=凸变换Halley) */
+
+    /* 迭代追踪（代替原verbose输出） */
+    PHTraceCallback trace_callback; /* 每次迭代调用的追踪回调（NULL=关闭） */
+    void *trace_user_data;      /* 传给追踪回调的用户数据（多线程共享同一options时须线程安全） */
+
+    /* 热启动 */
+    int warm_start_skip_tpd;    /* 热启动且上次为单相、沿用的K值仍指示同一单相时是否跳过TPD稳定性分析 */
 } FlashOptions;
 
+/**
+ * @brief 迭代追踪宏
+ * 回调为NULL时不构造事件；定义PH_DISABLE_TRACE时整个调用在编译期移除。
+ */
+#if defined(__GNUC__)
+#define PH_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+#define PH_UNLIKELY(x) (x)
+#endif
+
+#ifdef PH_DISABLE_TRACE
+#define PH_TRACE(options, src, iter, temp, h_err, beta_val, k_res, damp, anderson) ((void)(options))
+#else
+#define PH_TRACE(options, src, iter, temp, h_err, beta_val, k_res, damp, anderson) \
+    do { \
+        if (PH_UNLIKELY((options)->trace_callback != NULL)) { \
+            PHTraceEvent ph_trace_event_; \
+            ph_trace_event_.source = (src); \
+            ph_trace_event_.iteration = (iter); \
+            ph_trace_event_.T = (temp); \
+            ph_trace_event_.H_error = (h_err); \
+            ph_trace_event_.beta = (beta_val); \
+            ph_trace_event_.K_residual = (k_res); \
+            ph_trace_event_.damping = (damp); \
+            ph_trace_event_.anderson_status = (anderson); \
+            (options)->trace_callback(&ph_trace_event_, (options)->trace_user_data); \
+        } \
+    } while(0)
+#endif
+
 /* ph_error function is now declared in ph_error.h */
 
 #endif /* PH_DEFS_H */
\ No newline at end of file
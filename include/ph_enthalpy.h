@@ -46,6 +46,27 @@ PHErrorCode ph_enthalpy_shomate(double T, int component, const EnthalpyModel *mo
  */
 PHErrorCode ph_enthalpy_ideal_gas(double T, int component, const EnthalpyModel *model, double *H_ig);
 
+/**
+ * @brief 计算组分的理想气体定压热容（NASA-7/Shomate系数解析求导）
+ * @param T 温度 [K]
+ * @param component 组分索引
+ * @param model 组分的焓模型
+ * @param Cp_ig 存储理想气体热容的指针 [J/(mol·K)]
+ * @return 错误代码
+ */
+PHErrorCode ph_enthalpy_ideal_gas_cp(double T, int component, const EnthalpyModel *model, double *Cp_ig);
+
+/**
+ * @brief 计算混合物的理想气体定压热容
+ * @param T 温度 [K]
+ * @param composition 组分摩尔分数
+ * @param models 每个组分的焓模型数组
+ * @param Cp_ig_mix 存储混合物理想气体热容的指针 [J/(mol·K)]
+ * @return 错误代码
+ */
+PHErrorCode ph_enthalpy_ideal_gas_cp_mix(double T, const double *composition,
+                                        const EnthalpyModel models[NC], double *Cp_ig_mix);
+
 /**
  * @brief 计算混合物的理想气体焓
  * @param T 温度 [K]
@@ -86,6 +107,8 @@ PHErrorCode ph_enthalpy_mixture_total(StateProperties *state,
 
 /**
  * @brief 计算焓对温度的导数
+ * @note options->use_analytical_derivative开启时调用ph_enthalpy_derivative_analytical，
+ *       否则按derivative_perturbation数值差分
  * @param T 温度 [K]
  * @param P 压力 [Pa]
  * @param beta 气相摩尔分数
@@ -104,6 +127,34 @@ PHErrorCode ph_enthalpy_derivative(double T, double P, double beta,
                                   const FlashOptions *options,
                                   double *dH_dT);
 
+/**
+ * @brief 解析计算焓对温度的导数
+ *
+ * dH/dT = beta*Cp_V + (1-beta)*Cp_L + (H_V - H_L)*dbeta/dT + 组成变化项，
+ * 其中各相Cp由理想气体热容与d²a/dT²给出的偏差项组成，dbeta/dT和dx/dT、dy/dT
+ * 由等温闪蒸方程（逸度平衡 + Rachford-Rice）的隐函数求导得到，不需要额外的VLE计算。
+ * 单相状态（beta为0或1）仅保留对应相的Cp。
+ *
+ * 液相和气相的a_mix、da/dT、d²a/dT²分别由x、y和params的a_ij缓存在函数内
+ * 计算为局部量，不使用params的混合物级字段（a_mix、da_dT），
+ * 也不复制params；同一个params同时服务两相。
+ *
+ * @param T 温度 [K]
+ * @param P 压力 [Pa]
+ * @param beta 气相摩尔分数
+ * @param x 液相组成
+ * @param y 气相组成
+ * @param models 每个组分的焓模型数组
+ * @param params PR状态方程参数（a_ij缓存须对应温度T有效）
+ * @param dH_dT 存储焓导数的指针 [J/(mol·K)]
+ * @return 错误代码
+ */
+PHErrorCode ph_enthalpy_derivative_analytical(double T, double P, double beta,
+                                             const double *x, const double *y,
+                                             const EnthalpyModel models[NC],
+                                             const PREOSParams *params,
+                                             double *dH_dT);
+
 /**
  * @brief 确保温度边界处的多项式连续性
  * @param models 每个组分的焓模型数组
@@ -7,9 +7,26 @@
 #define PH_EOS_H
 
 #include "ph_defs.h"
+#include "ph_simd.h"
+
+/**
+ * @brief 单相PR状态方程计算结果（融合核函数输出）
+ */
+typedef struct {
+    double a_mix;              /* 混合物'a'参数 */
+    double b_mix;              /* 混合物'b'参数 */
+    double da_dT;              /* a_mix的温度导数 */
+    double Z;                  /* 压缩因子 */
+    double ln_phi[NC];         /* 逸度系数的自然对数 */
+    double H_dep;              /* 焓偏差 [J/mol] */
+} PHPhaseEval;
 
 /**
  * @brief 初始化PR状态方程组分参数
+ * @note 总是完整初始化params（按options设置kij、bip_source、use_quantum_h2，
+ *       在T处计算纯组分量并令T_pure = T，清空a_ij缓存），
+ *       不读取params原有内容，可直接传入未初始化的栈上结构；同一温度下
+ *       复用params时无需再次调用，a_ij缓存由ph_eos_update_aij_cache命中
  * @param T 温度 [K]
  * @param params PR状态方程参数结构指针
  * @param options 闪蒸计算选项
@@ -17,6 +34,40 @@
  */
 PHErrorCode ph_eos_init_params(double T, PREOSParams *params, const FlashOptions *options);
 
+/**
+ * @brief 更新温度相关的a_ij及其温度导数缓存
+ *
+ * 缓存以(T, bip_source, bip_version)为键：三者均与缓存记录相同且缓存有效时
+ * 不做任何计算。否则，若T与params->T_pure不同，先在T处重新计算温度相关的
+ * 纯组分量：use_quantum_h2开启时由ph_eos_h2_quantum_correction(T)更新H2的
+ * Tc_used、Pc_used，再由alpha(T)重算a_pure并由Tc_used、Pc_used重算b_pure，
+ * 并令T_pure = T；然后由a_pure、alpha(T)导数和kij重建aij、daij_dT、d2aij_dT2和
+ * b_padded（填充到PH_NC_PADDED，填充项为0）并更新键值。因此任意温度下调用
+ * 都得到与在该温度调用ph_eos_init_params相同的a_ij。
+ * ph_eos_calc_mixture_params、ph_eos_calc_fugacity_coeffs和ph_eos_calc_da_dt
+ * 均读取该缓存。
+ *
+ * @param T 温度 [K]
+ * @param params PR状态方程参数（需已由ph_eos_init_params初始化）
+ * @return 错误代码
+ */
+PHErrorCode ph_eos_update_aij_cache(double T, PREOSParams *params);
+
+/**
+ * @brief 替换params中的BIP矩阵并递增bip_version，使a_ij缓存在下次更新时重建
+ * @param params PR状态方程参数
+ * @param kij 新的BIP矩阵
+ * @param bip_source 新BIP矩阵的来源
+ * @return 错误代码
+ */
+PHErrorCode ph_eos_set_kij(PREOSParams *params, const double kij[NC][NC], int bip_source);
+
+/**
+ * @brief 使a_ij缓存失效（不经ph_eos_set_kij直接修改params->kij后必须调用）
+ * @param params PR状态方程参数
+ */
+void ph_eos_invalidate_aij_cache(PREOSParams *params);
+
 /**
  * @brief 计算混合物的PR状态方程参数
  * @param T 温度 [K]
@@ -42,18 +93,72 @@ PHErrorCode ph_eos_calc_z_factor(double T, double P, const PREOSParams *params,
 
 /**
  * @brief 使用PR状态方程计算逸度系数
+ *
+ * 只读取params：a_ij缓存须已由调用方对温度T调用ph_eos_update_aij_cache
+ * （与ph_eos_calc_fugacity_derivatives相同的前提），缓存无效或温度不符时
+ * 返回PH_ERROR_INPUT_INCONSISTENT，不在此处重建缓存。因此同一个const params
+ * 可由两相、TPD试探和多个线程同时使用。
+ *
  * @param T 温度 [K]
  * @param P 压力 [Pa]
  * @param composition 组分摩尔分数
- * @param params PR状态方程参数
+ * @param params PR状态方程参数（a_ij缓存须对应温度T有效）
  * @param phase 相类型（液相/气相）
- * @param phi 存储逸度系数的数组
+ * @param phi 存储逸度系数的数组 [NC]
  * @return 错误代码
  */
 PHErrorCode ph_eos_calc_fugacity_coeffs(double T, double P, const double *composition,
                                        const PREOSParams *params, PhaseType phase,
                                        double *phi);
 
+/**
+ * @brief 解析计算逸度系数对数及其温度、压力和摩尔数导数
+ *
+ * 由PR方程解析表达式计算，以总摩尔数1 mol为基准；dlnphi_dn[i][j]为
+ * d(ln phi_i)/d(n_j)（对称矩阵，满足Gibbs-Duhem关系sum_i x_i dlnphi_dn[i][j] = 0）。
+ * 任一导数输出指针为NULL时跳过对应计算。该相的混合物参数及其温度导数
+ * 由composition与a_ij缓存在函数内计算，同一个const params可用于两相。
+ *
+ * @param T 温度 [K]
+ * @param P 压力 [Pa]
+ * @param composition 组分摩尔分数
+ * @param params PR状态方程参数（a_ij缓存须对应温度T有效）
+ * @param phase 相类型（液相/气相）
+ * @param ln_phi 存储逸度系数对数的数组 [NC]
+ * @param dlnphi_dT 存储温度导数的数组 [NC] [1/K]
+ * @param dlnphi_dP 存储压力导数的数组 [NC] [1/Pa]
+ * @param dlnphi_dn 存储摩尔数导数的矩阵 [NC][NC] [1/mol]
+ * @return 错误代码
+ */
+PHErrorCode ph_eos_calc_fugacity_derivatives(double T, double P, const double *composition,
+                                            const PREOSParams *params, PhaseType phase,
+                                            double ln_phi[NC], double dlnphi_dT[NC],
+                                            double dlnphi_dP[NC], double dlnphi_dn[NC][NC]);
+
+/**
+ * @brief 使用填充的a_ij缓存向量化计算逸度系数
+ *
+ * 组分维度按PH_NC_PADDED处理（一个AVX-512或两个AVX2寄存器），直接读取
+ * params->aij和params->b_padded，使用ph_simd_log_array/ph_simd_exp_array；
+ * ph_simd_get_level低于PH_SIMD_AVX2时使用标量实现。
+ *
+ * ph_eos_calc_fugacity_coeffs在AVX2及以上的CPU上自动分派到本函数，分派只读取
+ * params（不更新a_ij缓存，也不复制或重排kij和a_ij）：把NC个组成复制到栈上对齐的
+ * PH_NC_PADDED长度缓冲区（填充位为0），本函数结果写入同样对齐的栈上
+ * PH_NC_PADDED长度缓冲区，再把前NC个值复制回调用方的phi[NC]。
+ *
+ * @param T 温度 [K]
+ * @param P 压力 [Pa]
+ * @param composition 组分摩尔分数，长度PH_NC_PADDED且按PH_SIMD_ALIGNMENT对齐，填充位为0
+ * @param params PR状态方程参数（a_ij缓存须对应温度T有效，a_mix、b_mix需已计算）
+ * @param phase 相类型（液相/气相）
+ * @param phi 存储逸度系数的数组，长度PH_NC_PADDED
+ * @return 错误代码
+ */
+PHErrorCode ph_eos_calc_fugacity_coeffs_simd(double T, double P, const double *composition,
+                                            const PREOSParams *params, PhaseType phase,
+                                            double *phi);
+
 /**
  * @brief 使用PR状态方程计算焓偏差
  * @param T 温度 [K]
@@ -68,6 +173,27 @@ PHErrorCode ph_eos_calc_enthalpy_departure(double T, double P, const double *com
                                           const PREOSParams *params, double Z,
                                           double *H_dep);
 
+/**
+ * @brief 单次遍历计算一个相的全部PR状态方程性质（融合核函数）
+ *
+ * 直接读取params->aij、daij_dT和b_padded（不重算a_ij交叉项），一次遍历计算
+ * sum_j x_j a_ij，同时得到a_mix、b_mix、da/dT、Z、ln phi和焓偏差，代替依次调用ph_eos_calc_mixture_params、ph_eos_calc_z_factor、
+ * ph_eos_calc_fugacity_coeffs和ph_eos_calc_enthalpy_departure，
+ * 每相只计算一次log((Z+(1+sqrt2)B)/(Z+(1-sqrt2)B))。
+ *
+ * @param T 温度 [K]
+ * @param P 压力 [Pa]
+ * @param composition 组分摩尔分数
+ * @param params PR状态方程参数（a_ij缓存须对应温度T有效，不被修改；
+ *               缓存无效或温度不符时返回PH_ERROR_INPUT_INCONSISTENT）
+ * @param phase 相类型（液相/气相）
+ * @param eval 存储计算结果的结构指针
+ * @return 错误代码
+ */
+PHErrorCode ph_eos_eval_phase(double T, double P, const double *composition,
+                             const PREOSParams *params, PhaseType phase,
+                             PHPhaseEval *eval);
+
 /**
  * @brief 获取H2的量子修正临界参数
  * @param T 温度 [K]
@@ -87,6 +213,23 @@ PHErrorCode ph_eos_h2_quantum_correction(double T, double *Tc_eff, double *Pc_ef
  */
 PHErrorCode ph_eos_solve_cubic_eq(double A, double B, PhaseType phase, double *Z);
 
+/**
+ * @brief 批量求解状态方程的三次方程（向量化）
+ *
+ * 每次处理2/4/8个方程（SSE2/AVX2/AVX-512，按ph_simd_get_level运行时选择，
+ * 不支持时使用标量实现），采用无分支的三角/Cardano公式求根，再做一次
+ * Newton修正；所选根与ph_eos_solve_cubic_eq的相根选择规则一致。
+ *
+ * @param n 方程个数
+ * @param A 三次Z方程中的A系数数组，长度n
+ * @param B 三次Z方程中的B系数数组，长度n
+ * @param phase 相类型（液相/气相），对全部方程相同
+ * @param Z 存储压缩因子的数组，长度n
+ * @return 错误代码（任一方程无有效根时返回PH_ERROR_ALGORITHM_EOS_FAILURE，该方程Z为0）
+ */
+PHErrorCode ph_eos_solve_cubic_batch(int n, const double *A, const double *B,
+                                    PhaseType phase, double *Z);
+
 /**
 * @brief 计算参数a的温度导数
 * @param T 温度 [K]
@@ -96,6 +239,25 @@ PHErrorCode ph_eos_solve_cubic_eq(double A, double B, PhaseType phase, double *Z
 */
 PHErrorCode ph_eos_calc_da_dt(double T, const double *composition, PREOSParams *params);
 
+/**
+ * @brief 计算焓偏差对温度的导数（恒压、恒组成）
+ *
+ * 该相的a_mix、b_mix、da/dT和d²a/dT²由composition与params的a_ij缓存
+ * （aij、daij_dT、d2aij_dT2）在函数内计算，不读取也不修改params的混合物级字段，
+ * 因此同一个const params可分别用于液相和气相。
+ *
+ * @param T 温度 [K]
+ * @param P 压力 [Pa]
+ * @param composition 组分摩尔分数
+ * @param params PR状态方程参数（a_ij缓存须对应温度T有效）
+ * @param Z 压缩因子
+ * @param dHdep_dT 存储焓偏差温度导数的指针 [J/(mol·K)]
+ * @return 错误代码
+ */
+PHErrorCode ph_eos_calc_enthalpy_departure_dT(double T, double P, const double *composition,
+                                             const PREOSParams *params, double Z,
+                                             double *dHdep_dT);
+
 /**
  * @brief 创建二元相互作用参数(BIP)矩阵
  * @param options 闪蒸计算选项
@@ -13,6 +13,32 @@
 #include <time.h>
 #include <stdarg.h>
 
+/**
+ * @brief 线程局部存储
+ */
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define PH_THREAD_LOCAL _Thread_local
+#elif defined(_MSC_VER)
+#define PH_THREAD_LOCAL __declspec(thread)
+#else
+#define PH_THREAD_LOCAL __thread
+#endif
+
+/**
+ * @brief 跨线程读写计数用的relaxed原子访问
+ * ptr和out/in为同类型（int或double）的指针；MSVC下x86/x64对齐的4/8字节
+ * volatile访问不可分割，等价于relaxed原子访问。
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define PH_ATOMIC_LOAD_RELAXED(type, ptr, out) __atomic_load((ptr), (out), __ATOMIC_RELAXED)
+#define PH_ATOMIC_STORE_RELAXED(type, ptr, in) __atomic_store((ptr), (in), __ATOMIC_RELAXED)
+#elif defined(_MSC_VER)
+#define PH_ATOMIC_LOAD_RELAXED(type, ptr, out) (*(out) = *(volatile const type *)(ptr))
+#define PH_ATOMIC_STORE_RELAXED(type, ptr, in) (*(volatile type *)(ptr) = *(in))
+#else
+#error "PH_ATOMIC_LOAD_RELAXED: unsupported compiler"
+#endif
+
 /**
  * @brief 扩展的错误代码体系 - 分类化的错误处理
  */
@@ -156,9 +182,16 @@ typedef struct {
     double last_error_time;       /* 最后错误时间 */
 } PHErrorStats;
 
-/* 全局错误管理器 */
-extern PHErrorInfo* g_current_error;
-extern PHErrorStats g_error_stats;
+/*
+ * 错误管理器
+ * 当前错误链和错误统计为线程局部变量，闪蒸失败时只写本线程数据，
+ * 不触及共享缓存行；ph_error_dump_stats/ph_error_merge_stats按需汇总各线程计数。
+ * g_error_stats只由所属线程写入，每个字段都用PH_ATOMIC_STORE_RELAXED写、
+ * 汇总线程用PH_ATOMIC_LOAD_RELAXED读，不能直接赋值或用+=修改。
+ * 日志开关和日志文件为进程级配置，仅由ph_error_init_logging/ph_error_cleanup_logging修改。
+ */
+extern PH_THREAD_LOCAL PHErrorInfo* g_current_error;
+extern PH_THREAD_LOCAL PHErrorStats g_error_stats;
 extern int g_error_logging_enabled;
 extern FILE* g_error_log_file;
 
@@ -222,8 +255,31 @@ void ph_error_init_logging(const char* log_file_path);
 void ph_error_cleanup_logging(void);
 void ph_error_log(PHErrorCode code, const char* message);
 void ph_error_dump_stats(FILE* output);
+
+/**
+ * @brief 清零调用线程的错误计数和已退出线程的汇总计数
+ * 其他在运行线程的计数不被修改（每个线程的计数只由其自身写入，因此不与
+ * 这些线程的写入竞争）；需要全部清零时在每个线程中调用，例如在两次
+ * ph_parallel_flash_batch之间由各工作线程执行，或在重置前后各取一次
+ * ph_error_merge_stats并取差值。
+ */
 void ph_error_reset_stats(void);
 
+/**
+ * @brief 线程错误统计管理
+ * 线程在首次记录错误时登记到进程级登记表，同时通过pthread_key_create
+ * （Windows下为FlsAlloc）注册线程退出析构函数：线程退出时自动将计数并入
+ * 已退出线程汇总、释放错误链并从登记表注销，不会留下指向已释放TLS的指针。
+ * 登记表由互斥锁保护，只在登记、注销和汇总时加锁，记录错误的路径不加锁。
+ * ph_error_merge_stats在锁内用PH_ATOMIC_LOAD_RELAXED逐字段读取所有已登记
+ * 线程的计数并加上已退出线程的汇总，不阻塞写入线程；各字段单独原子读取，
+ * 与正在写入的线程并发时字段之间可能不一致（如total_errors比分类计数之和
+ * 多一次），但不存在数据竞争。ph_error_thread_cleanup可在
+ * 线程退出前提前执行同样的清理，重复调用无副作用。
+ */
+void ph_error_merge_stats(PHErrorStats* total);
+void ph_error_thread_cleanup(void);
+
 /**
  * @brief 错误上下文管理
  */
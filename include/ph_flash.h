@@ -10,8 +10,27 @@
 #include "ph_eos.h"
 #include "ph_enthalpy.h"
 #include "ph_vle.h"
+#include "ph_anderson.h"
+#include "ph_utils.h"
 
  /**
+ * @brief inside-out简化热力学模型
+ *
+ * ln K_i = A_i + B_i/T，各相焓偏差在T_ref附近线性化：
+ * H_dep(T) = H_dep_ref + dHdep_dT*(T - T_ref)。
+ */
+typedef struct {
+    double A[NC];              /* ln K截距 */
+    double B[NC];              /* ln K对1/T的斜率 [K] */
+    double T_ref;              /* 模型参考温度 [K] */
+    double H_dep_L_ref;        /* 参考温度下液相焓偏差 [J/mol] */
+    double dHdep_L_dT;         /* 液相焓偏差温度导数 [J/(mol·K)] */
+    double H_dep_V_ref;        /* 参考温度下气相焓偏差 [J/mol] */
+    double dHdep_V_dT;         /* 气相焓偏差温度导数 [J/(mol·K)] */
+    int valid;                 /* 模型是否已拟合 */
+} PHInsideOutModel;
+
+/**
  * @brief 计算混合物的近似沸点
  * @param z 进料组成
  * @param P 压力 [Pa]
@@ -71,8 +90,224 @@ PHErrorCode ph_flash_estimate_init_temp(const double *z, double P, double H_spec
 PHErrorCode ph_flash_calculate(const double *z, double P, double H_spec,
                               const FlashOptions *options, StateProperties *state);
 
+/**
+ * @brief 执行P-H闪蒸计算并输出本次的性能计数
+ *
+ * 与ph_flash_calculate结果相同；stats先清零，再在调用期间经
+ * ph_flash_stats_set_current设为本线程的计数接收者，写入本次闪蒸的计数和
+ * 分阶段耗时。stats由调用方独占，多线程时每个线程使用各自的结构。
+ *
+ * @param z 进料组成
+ * @param P 压力 [Pa]
+ * @param H_spec 指定焓值 [J/mol]
+ * @param options 闪蒸计算选项
+ * @param state 状态属性结构的指针
+ * @param stats 存储性能计数的结构指针
+ * @return 错误代码
+ */
+PHErrorCode ph_flash_calculate_stats(const double *z, double P, double H_spec,
+                                    const FlashOptions *options, StateProperties *state,
+                                    PHFlashStats *stats);
+
+/**
+ * @brief 批量执行P-H闪蒸计算（结构数组SoA输入）
+ *
+ * 临界性质、焓模型和BIP矩阵在整个批次中只初始化一次，
+ * 每个点经ph_flash_solve_engine按options->flash_engine分派（与ph_flash_calculate
+ * 相同），结果与逐点调用ph_flash_calculate逐位一致。单点失败不会中断批次，其错误代码
+ * 写入对应results[k].status。本函数不收集性能计数，需要时使用
+ * 开启统计的上下文调用ph_flash_calculate_batch_ctx。
+ *
+ * @param n_points 计算点数
+ * @param z_soa 进料组成，按组分分块存储: z_soa[i * n_points + k] 为第k点组分i的摩尔分数
+ * @param P 压力数组 [Pa]，长度n_points
+ * @param H_spec 指定焓值数组 [J/mol]，长度n_points
+ * @param options 闪蒸计算选项
+ * @param results 结果数组，长度n_points
+ * @return 错误代码（全部点成功返回PH_OK，否则返回首个失败点的错误代码）
+ */
+PHErrorCode ph_flash_calculate_batch(int n_points, const double *z_soa,
+                                    const double *P, const double *H_spec,
+                                    const FlashOptions *options,
+                                    StateProperties *results);
+
+/**
+ * @brief 闪蒸计算上下文（不透明类型）
+ *
+ * 持有由FlashOptions预先计算的临界性质、焓模型（已做连续性处理）
+ * 和BIP矩阵，可在多次闪蒸计算间重复使用。
+ * 上下文的创建/释放及ph_flash_calculate_batch在ph_flash_context.c中实现，
+ * 是闪蒸路径上仅有的堆分配位置；ph_flash.c中的温度循环和线搜索不分配堆内存
+ * （由make check-nomalloc检查）。
+ */
+typedef struct PHFlashContext PHFlashContext;
+
+/**
+ * @brief 创建闪蒸计算上下文
+ * @param options 闪蒸计算选项（内容被复制到上下文中）
+ * @param ctx 存储新上下文指针的指针
+ * @return 错误代码
+ */
+PHErrorCode ph_flash_context_create(const FlashOptions *options, PHFlashContext **ctx);
+
+/**
+ * @brief 释放闪蒸计算上下文并将指针设为NULL
+ * @param ctx 上下文指针的指针
+ */
+void ph_flash_context_destroy(PHFlashContext **ctx);
+
+/**
+ * @brief 使用预先初始化的上下文执行P-H闪蒸计算
+ * @param ctx 闪蒸计算上下文
+ * @param z 进料组成
+ * @param P 压力 [Pa]
+ * @param H_spec 指定焓值 [J/mol]
+ * @param state 状态属性结构的指针
+ * @return 错误代码
+ */
+PHErrorCode ph_flash_calculate_ctx(PHFlashContext *ctx, const double *z, double P,
+                                  double H_spec, StateProperties *state);
+
+/**
+ * @brief 使用预先初始化的上下文批量执行P-H闪蒸计算
+ *
+ * 每个点经ph_flash_solve_engine按上下文选项的flash_engine分派，
+ * use_adaptive_tpd_order关闭时结果与逐点调用ph_flash_calculate_ctx逐位一致。
+ *
+ * @param ctx 闪蒸计算上下文
+ * @param n_points 计算点数
+ * @param z_soa 进料组成，布局同ph_flash_calculate_batch
+ * @param P 压力数组 [Pa]
+ * @param H_spec 指定焓值数组 [J/mol]
+ * @param results 结果数组，长度n_points
+ * @return 错误代码
+ */
+PHErrorCode ph_flash_calculate_batch_ctx(PHFlashContext *ctx, int n_points,
+                                        const double *z_soa, const double *P,
+                                        const double *H_spec,
+                                        StateProperties *results);
+
+/**
+ * @brief 获取上下文中使用的闪蒸选项
+ * @param ctx 闪蒸计算上下文
+ * @return 选项指针（生命周期与上下文相同）
+ */
+const FlashOptions* ph_flash_context_get_options(const PHFlashContext *ctx);
+
+/**
+ * @brief 开启或关闭上下文的性能计数累计
+ *
+ * 开启后，使用该上下文的每次闪蒸（ph_flash_calculate_ctx、
+ * ph_flash_calculate_batch_ctx的每个点、ph_flash_calculate_ctx_warm）
+ * 的计数和分阶段耗时都累加到上下文的统计中，不会相互覆盖；
+ * 关闭时不读取时钟。每次闪蒸期间上下文的统计被设为本线程的计数接收者
+ * （ph_flash_stats_set_current），底层函数的计数直接累加进去。上下文同一时刻
+ * 只能被一个线程使用，因此累计无需同步。
+ *
+ * @param ctx 闪蒸计算上下文
+ * @param enable 1表示开启，0表示关闭
+ */
+void ph_flash_context_enable_stats(PHFlashContext *ctx, int enable);
+
+/**
+ * @brief 获取上下文累计的性能计数
+ * @param ctx 闪蒸计算上下文
+ * @return 统计指针（生命周期与上下文相同）
+ */
+const PHFlashStats* ph_flash_context_get_stats(const PHFlashContext *ctx);
+
+/**
+ * @brief 清零上下文累计的性能计数
+ * @param ctx 闪蒸计算上下文
+ */
+void ph_flash_context_reset_stats(PHFlashContext *ctx);
+
+/**
+ * @brief 为上下文指定闪蒸工作区
+ *
+ * 未指定时使用ph_workspace_thread_local。工作区生命周期须覆盖上下文的使用期，
+ * 且同一时刻只能被一个线程使用。
+ *
+ * @param ctx 闪蒸计算上下文
+ * @param ws 工作区（NULL表示恢复使用线程工作区）
+ * @return 错误代码
+ */
+PHErrorCode ph_flash_context_set_workspace(PHFlashContext *ctx, PHWorkspace *ws);
+
+/**
+ * @brief 获取上下文累计的TPD试探统计
+ *
+ * 上下文选项的use_adaptive_tpd_order开启时，使用该上下文的闪蒸把此统计经
+ * ph_flash_solve_engine、ph_flash_temperature_iteration_ordered传给
+ * ph_vle_isothermal_flash_cached，按成功率顺序进行TPD分析并累计计数。
+ * 顺序在一次ph_flash_calculate_batch_ctx内固定，批次结束时由
+ * ph_vle_tpd_stats_update_order按累计计数更新；单点调用只累计计数。
+ *
+ * 开启后K值种子取按当前顺序首个不稳定的试探，结果在收敛容差内与关闭时一致，
+ * 但不再逐位相同，且随上下文历史变化（并行批量中随工作窃取的分配变化）。
+ * 关闭时（默认）统计不被更新，使用枚举顺序，ph_flash_calculate、批量及并行
+ * 计算之间逐位一致。
+ *
+ * @param ctx 闪蒸计算上下文
+ * @return 统计指针（生命周期与上下文相同）
+ */
+const PHTPDTrialStats* ph_flash_context_get_tpd_stats(const PHFlashContext *ctx);
+
+/**
+ * @brief 以上一次的解为初值执行P-H闪蒸计算（热启动）
+ *
+ * 用previous中的T、K和beta代替ph_flash_estimate_init_temp和Wilson初值，
+ * 若提供anderson则沿用其中的温度加速历史。
+ *
+ * options->warm_start_skip_tpd开启且previous为单相时，每次等温闪蒸先用
+ * previous->K在当前温度下计算Rachford-Rice函数F(beta)=sum z_i(K_i-1)/(1+beta(K_i-1))：
+ * previous为液相且F(0) <= 0，或previous为气相且F(1) >= 0（即无约束RR的beta
+ * 落在(0,1)之外、且在previous相态一侧）时，视为仍为同一单相并跳过TPD稳定性分析；
+ * 否则照常进行TPD分析。该判据只需一次O(NC)求值，不求解逸度；K值来自上一次
+ * 的解，因此跨越相界较远时仍由TPD判定。
+ *
+ * previous无效（status不为PH_OK，或任一组分|z_i - previous->z_i|超过
+ * TOL_WARM_START_COMPOSITION）时退化为ph_flash_calculate。
+ *
+ * @param z 进料组成
+ * @param P 压力 [Pa]
+ * @param H_spec 指定焓值 [J/mol]
+ * @param options 闪蒸计算选项
+ * @param previous 同一物流上一次闪蒸的结果
+ * @param anderson 温度循环的Anderson加速器实例（可为NULL，结束时更新为本次历史）
+ * @param state 状态属性结构的指针（可与previous指向同一结构）
+ * @return 错误代码
+ */
+PHErrorCode ph_flash_calculate_warm(const double *z, double P, double H_spec,
+                                   const FlashOptions *options,
+                                   const StateProperties *previous,
+                                   AndersonState *anderson,
+                                   StateProperties *state);
+
+/**
+ * @brief 使用预先初始化的上下文执行热启动P-H闪蒸计算
+ * @param ctx 闪蒸计算上下文
+ * @param z 进料组成
+ * @param P 压力 [Pa]
+ * @param H_spec 指定焓值 [J/mol]
+ * @param previous 同一物流上一次闪蒸的结果
+ * @param anderson 温度循环的Anderson加速器实例（可为NULL）
+ * @param state 状态属性结构的指针
+ * @return 错误代码
+ */
+PHErrorCode ph_flash_calculate_ctx_warm(PHFlashContext *ctx, const double *z,
+                                       double P, double H_spec,
+                                       const StateProperties *previous,
+                                       AndersonState *anderson,
+                                       StateProperties *state);
+
 /**
  * @brief P-H闪蒸的温度迭代循环
+ * @note 温度加速使用函数内局部的AndersonState实例，不依赖全局状态
+ * @note options->use_stability_skip开启时，函数内建立局部PHStabilityCache并在
+ *       开始时重置，每次外循环迭代经ph_vle_isothermal_flash_cached传入，
+ *       使稳定性分析结果在同一次闪蒸的各温度间传递
+ * @note 每次迭代通过PH_TRACE调用options->trace_callback
  * @param z 进料组成
  * @param P 压力 [Pa]
  * @param H_spec 指定焓值 [J/mol]
@@ -90,6 +325,138 @@ PHErrorCode ph_flash_temperature_iteration(const double *z, double P, double H_s
                                           const FlashOptions *options,
                                           StateProperties *state);
 
+/**
+ * @brief 按TPD试探统计排序稳定性分析的温度迭代循环
+ *
+ * 与ph_flash_temperature_iteration相同，每次外循环迭代把tpd_stats传给
+ * ph_vle_isothermal_flash_cached；tpd_stats为NULL时与ph_flash_temperature_iteration
+ * 逐位一致。
+ *
+ * @param z 进料组成
+ * @param P 压力 [Pa]
+ * @param H_spec 指定焓值 [J/mol]
+ * @param T_init 初始温度猜测值 [K]
+ * @param critical_props 临界性质数组
+ * @param models 焓模型数组
+ * @param options 闪蒸计算选项
+ * @param tpd_stats TPD试探统计（可为NULL）
+ * @param state 状态属性结构的指针
+ * @return 错误代码
+ */
+PHErrorCode ph_flash_temperature_iteration_ordered(const double *z, double P, double H_spec,
+                                                  double T_init,
+                                                  const CriticalProps critical_props[NC],
+                                                  const EnthalpyModel models[NC],
+                                                  const FlashOptions *options,
+                                                  PHTPDTrialStats *tpd_stats,
+                                                  StateProperties *state);
+
+/**
+ * @brief 按options->flash_engine选择求解引擎执行P-H闪蒸
+ *
+ * FLASH_ENGINE_NESTED调用ph_flash_temperature_iteration，FLASH_ENGINE_NEWTON调用
+ * ph_flash_newton_simultaneous，FLASH_ENGINE_INSIDE_OUT调用ph_flash_inside_out；
+ * 其他值返回PH_ERROR_CONFIG_INVALID。ph_flash_calculate、ph_flash_calculate_ctx、
+ * ph_flash_calculate_batch、ph_flash_calculate_batch_ctx和ph_parallel_flash_batch
+ * 在完成初始化和初值估计后都经由本函数求解，因此同一引擎下各入口结果一致。
+ * tpd_stats传给ph_flash_temperature_iteration_ordered（其他引擎的嵌套回退同样使用）；
+ * 无上下文的入口和use_adaptive_tpd_order关闭的上下文传入NULL。
+ *
+ * @param z 进料组成
+ * @param P 压力 [Pa]
+ * @param H_spec 指定焓值 [J/mol]
+ * @param T_init 初始温度猜测值 [K]
+ * @param critical_props 临界性质数组
+ * @param models 焓模型数组
+ * @param options 闪蒸计算选项
+ * @param tpd_stats TPD试探统计（可为NULL，此时按枚举顺序）
+ * @param state 状态属性结构的指针
+ * @return 错误代码
+ */
+PHErrorCode ph_flash_solve_engine(const double *z, double P, double H_spec,
+                                 double T_init,
+                                 const CriticalProps critical_props[NC],
+                                 const EnthalpyModel models[NC],
+                                 const FlashOptions *options,
+                                 PHTPDTrialStats *tpd_stats,
+                                 StateProperties *state);
+
+/**
+ * @brief (T, ln K, beta)联立Newton求解P-H闪蒸
+ *
+ * 以NC+2个未知量同时求解焓平衡、NC个逸度平衡方程和Rachford-Rice方程，
+ * Jacobian由ph_eos_calc_fugacity_derivatives和解析dH/dT组装，不嵌套等温闪蒸的内循环收敛。
+ * 初值由ph_flash_temperature_iteration的少量外循环迭代或热启动结果提供；
+ * 单相解或Jacobian奇异时回退到嵌套求解。options->flash_engine为
+ * FLASH_ENGINE_NEWTON时由ph_flash_solve_engine调用。
+ *
+ * @param z 进料组成
+ * @param P 压力 [Pa]
+ * @param H_spec 指定焓值 [J/mol]
+ * @param T_init 初始温度猜测值 [K]
+ * @param critical_props 临界性质数组
+ * @param models 焓模型数组
+ * @param options 闪蒸计算选项
+ * @param state 状态属性结构的指针（若state->K有效则作为K初值）
+ * @return 错误代码
+ */
+PHErrorCode ph_flash_newton_simultaneous(const double *z, double P, double H_spec,
+                                        double T_init,
+                                        const CriticalProps critical_props[NC],
+                                        const EnthalpyModel models[NC],
+                                        const FlashOptions *options,
+                                        StateProperties *state);
+
+/**
+ * @brief inside-out (Boston-Britt) P-H闪蒸
+ *
+ * 外循环在当前(T, x, y)处调用严格PR计算（ph_eos_calc_fugacity_coeffs、
+ * ph_eos_calc_enthalpy_departure）更新PHInsideOutModel；内循环只用简化模型
+ * 求解P-H平衡（温度与Rachford-Rice）。当严格K值与简化模型K值的最大相对偏差
+ * 小于TOL_K_VALUE且焓误差满足容差时收敛。options->flash_engine为
+ * FLASH_ENGINE_INSIDE_OUT时由ph_flash_solve_engine调用。
+ *
+ * @param z 进料组成
+ * @param P 压力 [Pa]
+ * @param H_spec 指定焓值 [J/mol]
+ * @param T_init 初始温度猜测值 [K]
+ * @param critical_props 临界性质数组
+ * @param models 焓模型数组
+ * @param options 闪蒸计算选项
+ * @param state 状态属性结构的指针
+ * @return 错误代码
+ */
+PHErrorCode ph_flash_inside_out(const double *z, double P, double H_spec,
+                               double T_init,
+                               const CriticalProps critical_props[NC],
+                               const EnthalpyModel models[NC],
+                               const FlashOptions *options,
+                               StateProperties *state);
+
+/**
+ * @brief 由严格PR计算更新inside-out简化模型
+ *
+ * 在state->T处计算严格K值和两相焓偏差。斜率B_i由同一点的解析温度导数给出：
+ * B_i = d(ln K_i)/d(1/T) = -T^2 (dlnphi_L,i/dT - dlnphi_V,i/dT)，其中dlnphi/dT
+ * 由ph_eos_calc_fugacity_derivatives计算（a_ij缓存在state->T处更新），
+ * A_i = ln K_i - B_i/T。不使用相邻两次严格点之间的割线斜率，外循环收敛、
+ * 相邻温度重合时斜率仍然有定义。dHdep_L_dT、dHdep_V_dT由
+ * ph_eos_calc_enthalpy_departure_dT在同一点计算。
+ *
+ * @param P 压力 [Pa]
+ * @param state 当前状态（提供T、x、y）
+ * @param critical_props 临界性质数组
+ * @param options 闪蒸计算选项
+ * @param model 待更新的简化模型
+ * @param K_rigorous 存储严格K值的数组
+ * @return 错误代码
+ */
+PHErrorCode ph_flash_io_update_model(double P, const StateProperties *state,
+                                    const CriticalProps critical_props[NC],
+                                    const FlashOptions *options,
+                                    PHInsideOutModel *model,
+                                    double K_rigorous[NC]);
+
 /**
  * @brief 应用线搜索改进温度更新
  * @param T_current 当前温度 [K]
@@ -138,6 +505,53 @@ PHErrorCode ph_flash_validate_solution(const StateProperties *state);
 PHErrorCode ph_flash_output_results(const StateProperties *state, 
                                    int output_format, FILE *output_file);
 
+/**
+ * @brief 设置当前线程的性能计数接收者
+ *
+ * 之后本线程中的三次方程求解、逸度和焓计算、RR和TPD迭代以及温度外循环
+ * 都经PH_STATS_ADD累加到stats（含分阶段耗时），直到再次设置。
+ * ph_flash_calculate_stats和开启统计的上下文闪蒸在调用期间把接收者设为
+ * 本次的计数（上下文为其累计结构），返回前恢复原值，因此可以嵌套；
+ * 接收者为线程局部变量，并行工作线程各自写入自己的上下文统计，互不竞争。
+ * 直接调用底层函数时需要计数，可自行设置后再恢复。
+ *
+ * @param stats 性能计数结构（NULL表示不计数）
+ * @return 原来的接收者
+ */
+PHFlashStats* ph_flash_stats_set_current(PHFlashStats *stats);
+
+/**
+ * @brief 清零性能计数
+ * @param stats 性能计数结构
+ */
+void ph_flash_stats_reset(PHFlashStats *stats);
+
+/**
+ * @brief 将一次闪蒸的性能计数累加到汇总结构
+ * @param total 汇总性能计数
+ * @param stats 单次闪蒸性能计数
+ */
+void ph_flash_stats_accumulate(PHFlashStats *total, const PHFlashStats *stats);
+
+/**
+ * @brief 输出性能计数
+ * @param stats 性能计数结构
+ * @param output_file 输出文件指针（如为NULL则使用stdout）
+ */
+void ph_flash_stats_print(const PHFlashStats *stats, FILE *output_file);
+
+/**
+ * @brief 以CSV行格式输出追踪事件的标准回调（代替原verbose输出）
+ *
+ * 每个事件输出一行: source,iteration,T,H_error,beta,K_residual,damping,anderson_status
+ * 每行由一次fprintf写出（stdio对每次调用加锁），多个线程共享同一FILE*时
+ * 行与行之间可能交错，但单行不会被拆开。
+ *
+ * @param event 追踪事件
+ * @param user_data 输出文件指针FILE*（如为NULL则使用stdout）
+ */
+void ph_flash_trace_csv(const PHTraceEvent *event, void *user_data);
+
 /**
  * @brief 分类操作条件类型
  * @param T 温度 [K]
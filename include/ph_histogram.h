@@ -0,0 +1,116 @@
+/**
+ * @file ph_histogram.h
+ * @brief 按操作条件和相态分类的闪蒸延迟直方图（HDR式对数分桶）
+ */
+
+#ifndef PH_HISTOGRAM_H
+#define PH_HISTOGRAM_H
+
+#include <stdint.h>
+#include "ph_defs.h"
+
+/**
+ * @brief 直方图设置
+ *
+ * 每个2的幂区间再等分为PH_HIST_SUB_BUCKETS个子桶，相对分辨率约为
+ * 1/PH_HIST_SUB_BUCKETS；可记录1到2^PH_HIST_MAGNITUDES的值（纳秒或迭代次数）。
+ */
+#define PH_HIST_SUB_BUCKET_BITS 4                            /* 子桶位数 */
+#define PH_HIST_SUB_BUCKETS (1 << PH_HIST_SUB_BUCKET_BITS)   /* 每个数量级的子桶数 */
+#define PH_HIST_MAGNITUDES 40                                /* 2的幂区间数 */
+#define PH_HIST_BUCKETS (PH_HIST_MAGNITUDES * PH_HIST_SUB_BUCKETS) /* 总桶数 */
+#define PH_HIST_CONDITIONS 3                                 /* 操作条件分类数 */
+
+/**
+ * @brief 闪蒸最终相态分类
+ */
+typedef enum {
+    PH_HIST_PHASE_LIQUID = 0,         /* 液相单相 */
+    PH_HIST_PHASE_VAPOR = 1,          /* 气相单相 */
+    PH_HIST_PHASE_TWO_PHASE = 2,      /* 气液两相 */
+    PH_HIST_PHASE_FAILED = 3,         /* 计算失败 */
+    PH_HIST_PHASE_COUNT = 4           /* 相态分类数 */
+} PHHistPhase;
+
+/**
+ * @brief 对数分桶直方图
+ */
+typedef struct {
+    uint64_t counts[PH_HIST_BUCKETS]; /* 各桶计数 */
+    uint64_t total_count;             /* 总记录数 */
+    uint64_t min_value;               /* 最小记录值 */
+    uint64_t max_value;               /* 最大记录值 */
+    double sum;                       /* 记录值之和（用于均值） */
+} PHLogHistogram;
+
+/**
+ * @brief 记录一次闪蒸的延迟和迭代次数
+ *
+ * 写入当前线程的直方图，不访问其他线程的数据，也不加锁。首次调用时把本线程
+ * 直方图登记到进程级登记表，并通过pthread_key_create（Windows下为FlsAlloc）
+ * 注册线程退出析构函数：线程退出时自动并入汇总并注销，登记表中不会留下
+ * 指向已释放TLS的指针。登记表由互斥锁保护，只在登记、注销和合并时加锁。
+ *
+ * @param condition 操作条件（ph_flash_classify_operating_condition的结果）
+ * @param phase 最终相态
+ * @param latency_ns 闪蒸耗时 [ns]
+ * @param iterations 迭代次数
+ */
+void ph_histogram_record(OperatingCondition condition, PHHistPhase phase,
+                         uint64_t latency_ns, int iterations);
+
+/**
+ * @brief 由闪蒸结果记录一次闪蒸
+ *
+ * 操作条件由state->T、state->P和state->z分类，相态由state->status和state->beta确定。
+ *
+ * @param state 闪蒸结果
+ * @param wall_time 闪蒸耗时 [s]（可由ph_monotonic_time差值得到）
+ */
+void ph_histogram_record_flash(const StateProperties *state, double wall_time);
+
+/**
+ * @brief 根据闪蒸结果确定相态分类
+ * @param state 闪蒸结果
+ * @return 相态分类
+ */
+PHHistPhase ph_histogram_phase_from_state(const StateProperties *state);
+
+/**
+ * @brief 合并所有线程中指定分类的直方图（读取时合并）
+ * @param condition 操作条件
+ * @param phase 相态
+ * @param latency 存储合并后延迟直方图的指针 [ns]（可为NULL）
+ * @param iterations 存储合并后迭代次数直方图的指针（可为NULL）
+ * @return 错误代码
+ */
+PHErrorCode ph_histogram_merge(OperatingCondition condition, PHHistPhase phase,
+                              PHLogHistogram *latency, PHLogHistogram *iterations);
+
+/**
+ * @brief 获取直方图的分位数值
+ * @param histogram 直方图
+ * @param percentile 百分位（0-100，如99.9）
+ * @return 分位数值（所在桶的上界；直方图为空时返回0）
+ */
+uint64_t ph_histogram_value_at_percentile(const PHLogHistogram *histogram, double percentile);
+
+/**
+ * @brief 输出各分类的记录数、均值以及p50/p90/p99/p99.9延迟和迭代次数
+ * @param output 输出文件指针（如为NULL则使用stdout）
+ */
+void ph_histogram_dump(FILE *output);
+
+/**
+ * @brief 清零所有线程的直方图（应在没有线程记录时调用）
+ */
+void ph_histogram_reset(void);
+
+/**
+ * @brief 提前将当前线程的直方图并入汇总并注销
+ *
+ * 线程退出时析构函数会自动执行同样的操作；本函数用于提前执行，重复调用无副作用。
+ */
+void ph_histogram_thread_cleanup(void);
+
+#endif /* PH_HISTOGRAM_H */
@@ -0,0 +1,128 @@
+/**
+ * @file ph_parallel.h
+ * @brief 多线程批量P-H闪蒸（固定线程池 + 工作窃取调度）
+ */
+
+#ifndef PH_PARALLEL_H
+#define PH_PARALLEL_H
+
+#include "ph_defs.h"
+#include "ph_flash.h"
+
+/**
+ * @brief 并行设置
+ */
+#define PH_PARALLEL_MAX_THREADS 256   /* 线程池最大线程数 */
+#define PH_PARALLEL_DEFAULT_GRAIN 16  /* 每个任务包含的默认闪蒸点数 */
+
+/**
+ * @brief 闪蒸线程池（不透明类型）
+ *
+ * 每个工作线程持有独立的PHFlashContext和双端任务队列：线程从自身队列
+ * 尾部取任务，队列为空时从其他线程队列头部窃取，以平衡标准条件与
+ * 极端条件之间成本相差10倍以上的闪蒸点。
+ */
+typedef struct PHWorkerPool PHWorkerPool;
+
+/**
+ * @brief 单个工作线程的利用率统计
+ */
+typedef struct {
+    int thread_id;              /* 线程编号 */
+    long tasks_executed;        /* 执行的任务数 */
+    long tasks_stolen;          /* 从其他线程窃取的任务数 */
+    long steal_attempts;        /* 窃取尝试次数 */
+    long points_processed;      /* 计算的闪蒸点数 */
+    double busy_time;           /* 执行闪蒸的时间 [s] */
+    double idle_time;           /* 空闲及窃取等待时间 [s] */
+    double utilization;         /* 利用率 busy_time/(busy_time+idle_time) */
+} PHThreadUtilization;
+
+/**
+ * @brief 创建闪蒸线程池
+ * @param n_threads 工作线程数（<=0时使用在线CPU核数，不超过PH_PARALLEL_MAX_THREADS）
+ * @param grain_size 每个任务的闪蒸点数（<=0时使用PH_PARALLEL_DEFAULT_GRAIN）
+ * @param options 闪蒸计算选项（用于创建每个线程的PHFlashContext）
+ * @param pool 存储线程池指针的指针
+ * @return 错误代码
+ */
+PHErrorCode ph_parallel_pool_create(int n_threads, int grain_size,
+                                   const FlashOptions *options, PHWorkerPool **pool);
+
+/**
+ * @brief 停止工作线程并释放线程池，将指针设为NULL
+ * @param pool 线程池指针的指针
+ */
+void ph_parallel_pool_destroy(PHWorkerPool **pool);
+
+/**
+ * @brief 获取线程池的工作线程数
+ * @param pool 线程池
+ * @return 线程数
+ */
+int ph_parallel_pool_get_thread_count(const PHWorkerPool *pool);
+
+/**
+ * @brief 使用线程池并行执行批量P-H闪蒸计算
+ *
+ * 输入布局与ph_flash_calculate_batch相同，每个点经ph_flash_solve_engine按
+ * options->flash_engine分派，结果与单点调用ph_flash_calculate一致（options的
+ * use_adaptive_tpd_order开启时只在收敛容差内一致，见ph_flash_context_get_tpd_stats）。
+ * 调用在所有点完成后返回；同一线程池不可被多个调用方同时使用。
+ *
+ * @param pool 线程池
+ * @param n_points 计算点数
+ * @param z_soa 进料组成: z_soa[i * n_points + k] 为第k点组分i的摩尔分数
+ * @param P 压力数组 [Pa]
+ * @param H_spec 指定焓值数组 [J/mol]
+ * @param results 结果数组，长度n_points
+ * @param utilization 每个线程的利用率统计，长度为线程数（可为NULL）
+ * @return 错误代码（全部点成功返回PH_OK，否则返回首个失败点的错误代码）
+ */
+PHErrorCode ph_parallel_flash_batch(PHWorkerPool *pool, int n_points,
+                                   const double *z_soa, const double *P,
+                                   const double *H_spec, StateProperties *results,
+                                   PHThreadUtilization *utilization);
+
+/**
+ * @brief 开启或关闭线程池各工作线程上下文的性能计数累计
+ * @param pool 线程池
+ * @param enable 1表示开启，0表示关闭
+ */
+void ph_parallel_pool_enable_stats(PHWorkerPool *pool, int enable);
+
+/**
+ * @brief 汇总各工作线程上下文累计的性能计数
+ *
+ * 每个工作线程只写自身上下文的统计，本函数在两次ph_parallel_flash_batch
+ * 之间（工作线程空闲时）调用，用ph_flash_stats_accumulate合并。
+ *
+ * @param pool 线程池
+ * @param total 存储汇总计数的结构指针
+ * @return 错误代码
+ */
+PHErrorCode ph_parallel_pool_get_stats(const PHWorkerPool *pool, PHFlashStats *total);
+
+/**
+ * @brief 为每个工作线程指定独立的追踪用户数据
+ *
+ * 工作线程k的上下文选项的trace_user_data被设为user_data[k]，使追踪回调在
+ * 各线程中收到不同的user_data（如每个线程一个FILE*或缓冲区），无需加锁。
+ * 在两次ph_parallel_flash_batch之间（工作线程空闲时）调用。
+ *
+ * @param pool 线程池
+ * @param user_data 用户数据数组，长度为线程数（为NULL时恢复为options->trace_user_data）
+ * @return 错误代码
+ */
+PHErrorCode ph_parallel_pool_set_trace_user_data(PHWorkerPool *pool, void *const *user_data);
+
+/**
+ * @brief 输出线程利用率统计
+ * @param utilization 线程利用率数组
+ * @param n_threads 线程数
+ * @param output 输出文件指针（如为NULL则使用stdout）
+ */
+void ph_parallel_print_utilization(const PHThreadUtilization *utilization,
+                                   int n_threads, FILE *output);
+
+#endif /* PH_PARALLEL_H */
@@ -0,0 +1,70 @@
+/**
+ * @file ph_simd.h
+ * @brief SIMD指令集运行时检测与分派
+ */
+
+#ifndef PH_SIMD_H
+#define PH_SIMD_H
+
+#include "ph_defs.h"
+
+/**
+ * @brief SIMD指令集级别（按向量宽度递增）
+ */
+typedef enum {
+    PH_SIMD_SCALAR = 0,               /* 标量实现 */
+    PH_SIMD_SSE2 = 1,                 /* SSE2, 2 x double */
+    PH_SIMD_AVX2 = 2,                 /* AVX2 + FMA, 4 x double */
+    PH_SIMD_AVX512 = 3                /* AVX-512F, 8 x double */
+} PHSimdLevel;
+
+/**
+ * @brief 检测当前CPU支持的最高SIMD级别（结果在首次调用后缓存）
+ * @return SIMD级别
+ */
+PHSimdLevel ph_simd_detect_level(void);
+
+/**
+ * @brief 获取向量化核函数当前使用的SIMD级别
+ * @return SIMD级别
+ */
+PHSimdLevel ph_simd_get_level(void);
+
+/**
+ * @brief 设置向量化核函数使用的SIMD级别（用于测试和对比，不会超过检测到的级别）
+ * @param level 期望的SIMD级别
+ * @return 实际生效的SIMD级别
+ */
+PHSimdLevel ph_simd_set_level(PHSimdLevel level);
+
+/**
+ * @brief 获取SIMD级别的名称
+ * @param level SIMD级别
+ * @return 级别名称字符串
+ */
+const char* ph_simd_level_to_string(PHSimdLevel level);
+
+/**
+ * @brief 获取SIMD级别对应的double向量宽度
+ * @param level SIMD级别
+ * @return 每个向量的double数(1, 2, 4或8)
+ */
+int ph_simd_lane_count(PHSimdLevel level);
+
+/**
+ * @brief 向量化自然对数（相对误差不超过2 ulp）
+ * @param x 输入数组（元素应为正数）
+ * @param result 输出数组（可与x相同）
+ * @param n 数组长度
+ */
+void ph_simd_log_array(const double *x, double *result, int n);
+
+/**
+ * @brief 向量化指数函数（相对误差不超过2 ulp）
+ * @param x 输入数组
+ * @param result 输出数组（可与x相同）
+ * @param n 数组长度
+ */
+void ph_simd_exp_array(const double *x, double *result, int n);
+
+#endif /* PH_SIMD_H */
@@ -21,6 +21,103 @@ void* ph_malloc(size_t size);
  */
 void ph_free(void** ptr);
 
+/**
+ * @brief 按指定边界对齐分配内存（用于PREOSParams等含对齐成员的结构）
+ * @param size 要分配的字节数
+ * @param alignment 对齐字节数（2的幂，如PH_SIMD_ALIGNMENT）
+ * @return 分配的内存指针，如果失败则返回NULL
+ */
+void* ph_malloc_aligned(size_t size, size_t alignment);
+
+/**
+ * @brief 释放ph_malloc_aligned分配的内存并将指针设为NULL
+ * @param ptr 要释放的内存指针的指针
+ */
+void ph_free_aligned(void** ptr);
+
+/**
+ * @brief 获取当前线程的堆分配累计次数（用于验证稳态闪蒸路径无堆分配）
+ *
+ * 计入ph_malloc和ph_malloc_aligned的每次调用；库内的堆分配（上下文、工作区、
+ * 错误链等）都经由这两个函数，因此该计数覆盖间接分配。
+ *
+ * @return 分配次数
+ */
+long ph_malloc_count(void);
+
+/**
+ * @brief 工作区设置
+ */
+#define PH_WORKSPACE_ALIGNMENT 64         /* 工作区分配对齐字节数（一个缓存行） */
+#define PH_WORKSPACE_DEFAULT_SIZE 65536   /* 线程工作区默认大小 [字节] */
+
+/**
+ * @brief 闪蒸工作区（连续内存块上的分层栈式分配器）
+ *
+ * Anderson历史、TPD试探向量和线搜索状态等临时数组均从同一块缓存行
+ * 对齐的连续内存中分配；每次闪蒸开始时记录标记，结束时回退到该标记，
+ * 稳态下不产生任何堆分配。
+ */
+typedef struct {
+    unsigned char *base;       /* 内存块起始地址 */
+    size_t capacity;           /* 容量 [字节] */
+    size_t used;               /* 已使用 [字节] */
+    size_t high_water;         /* 历史最大使用量 [字节] */
+    int owns_memory;           /* 内存是否由工作区分配（销毁时释放） */
+} PHWorkspace;
+
+/**
+ * @brief 初始化工作区
+ * @param ws 工作区
+ * @param buffer 调用方提供的内存（须按PH_WORKSPACE_ALIGNMENT对齐；为NULL时用
+ *               ph_malloc_aligned按PH_WORKSPACE_ALIGNMENT分配一次，可从中分配含对齐成员的PREOSParams）
+ * @param size 内存大小 [字节]
+ * @return 错误代码
+ */
+PHErrorCode ph_workspace_init(PHWorkspace *ws, void *buffer, size_t size);
+
+/**
+ * @brief 销毁工作区（仅释放工作区自行分配的内存）
+ * @param ws 工作区
+ */
+void ph_workspace_destroy(PHWorkspace *ws);
+
+/**
+ * @brief 从工作区分配按PH_WORKSPACE_ALIGNMENT对齐的内存
+ * @param ws 工作区
+ * @param size 要分配的字节数
+ * @return 分配的内存指针，如果空间不足则返回NULL
+ */
+void* ph_workspace_alloc(PHWorkspace *ws, size_t size);
+
+/**
+ * @brief 记录当前分配位置
+ * @param ws 工作区
+ * @return 分配位置标记
+ */
+size_t ph_workspace_mark(const PHWorkspace *ws);
+
+/**
+ * @brief 释放标记之后的全部分配（按分配的相反顺序分层释放）
+ * @param ws 工作区
+ * @param mark ph_workspace_mark返回的标记
+ */
+void ph_workspace_release(PHWorkspace *ws, size_t mark);
+
+/**
+ * @brief 获取当前线程的工作区（首次调用时分配PH_WORKSPACE_DEFAULT_SIZE字节）
+ * @return 工作区指针，分配失败返回NULL
+ */
+PHWorkspace* ph_workspace_thread_local(void);
+
+/**
+ * @brief 提前释放当前线程的工作区
+ *
+ * 线程工作区首次创建时通过pthread_key_create（Windows下为FlsAlloc）注册
+ * 线程退出析构函数，线程退出时自动释放；本函数用于提前释放，重复调用无副作用。
+ */
+void ph_workspace_thread_cleanup(void);
+
 /**
  * @brief 检查浮点数值是否接近零
  * @param value 待检查的值
@@ -89,6 +186,12 @@ double ph_max_relative_error(const double* array1, const double* array2,
  */
 int ph_sign(double value);
 
+/**
+ * @brief 获取单调时钟时间（clock_gettime(CLOCK_MONOTONIC)）
+ * @return 时间 [s]
+ */
+double ph_monotonic_time(void);
+
 /**
  * @brief 基于迭代历史计算自适应阻尼因子
  * @param iteration 当前迭代次数
@@ -8,9 +8,53 @@
 
 #include "ph_defs.h"
 #include "ph_eos.h"
+#include "ph_anderson.h"
 
 #define MAX_TPD_TRIALS 7
 
+/**
+ * @brief TPD试探组成类型
+ */
+typedef enum {
+    TPD_TRIAL_WILSON_VAPOR = 0,       /* Wilson类气相试探 (z*K) */
+    TPD_TRIAL_WILSON_LIQUID = 1,      /* Wilson类液相试探 (z/K) */
+    TPD_TRIAL_PURE_H2 = 2,            /* 纯H2试探 */
+    TPD_TRIAL_PURE_N2 = 3,            /* 纯N2试探 */
+    TPD_TRIAL_PURE_O2 = 4,            /* 纯O2试探 */
+    TPD_TRIAL_PURE_NH3 = 5,           /* 纯NH3试探 */
+    TPD_TRIAL_PURE_H2O = 6            /* 纯H2O试探 */
+} TPDTrialType;
+
+/**
+ * @brief TPD试探组成成功率统计及排序
+ */
+typedef struct {
+    long analyses;                    /* TPD分析次数 */
+    long attempts[MAX_TPD_TRIALS];    /* 各试探类型的尝试次数 */
+    long wins[MAX_TPD_TRIALS];        /* 按当前顺序各试探类型首先判定不稳定的次数 */
+    int order[MAX_TPD_TRIALS];        /* 当前试探顺序（TPDTrialType） */
+} PHTPDTrialStats;
+
+/**
+ * @brief 稳定性分析缓存（同一P-H闪蒸的各次温度迭代间传递）
+ *
+ * 记录上次TPD的驻点、TPD最小值和相数。单相状态下由TPD裕量推算
+ * 相数不变的温度区间（"影子区域"），区间内跳过TPD分析。
+ * 由ph_flash_temperature_iteration在每次P-H闪蒸开始时建立局部实例并重置，
+ * 经ph_vle_isothermal_flash_cached在各次外循环迭代间传递。
+ */
+typedef struct {
+    int valid;                  /* 缓存是否有效 */
+    int n_phases;               /* 上次判定的相数(1或2) */
+    int n_agree;                /* 相数与n_phases相同的连续完整分析次数 */
+    double stationary_point[NC]; /* 上次TPD的驻点组成 */
+    double tpd_min;             /* 上次TPD最小值（驻点处） */
+    double dtpd_dT;             /* 驻点TPD的温度变化率估计 [1/K]（n_agree >= 2时有效） */
+    double T_last;              /* 上次分析的温度 [K] */
+    double T_lower;             /* 单相跳过区间下限 [K]（由TPD裕量推算） */
+    double T_upper;             /* 单相跳过区间上限 [K]（由TPD裕量推算） */
+} PHStabilityCache;
+
  /**
  * @brief 在给定温度、压力下求解气液平衡
  * @param z 进料组成
@@ -44,6 +88,73 @@ PHErrorCode ph_vle_wilson_k_values(double T, double P,
  */
 PHErrorCode ph_vle_solve_rachford_rice(const double *z, const double *K, double *beta);
 
+/**
+ * @brief 使用凸变换和Halley迭代稳健求解Rachford-Rice方程
+ *
+ * 采用Leibovici-Nichita变换 G(a) = (a/(1-a)) * F(beta)，
+ * a = (beta - beta_min)/(beta_max - beta_min)，在K值跨越多个数量级
+ * （如H2的K~1e3与H2O的K~1e-4）时保持凸性；Halley步超出当前保护区间时
+ * 改用二分，区间在每次迭代后收缩，保证收敛。options->rr_solver为
+ * RR_SOLVER_CONVEX时由ph_vle_isothermal_flash调用。
+ *
+ * 作为ph_vle_solve_rachford_rice的替代，边界行为与其相同，判据为
+ * F(beta) = sum z_i(K_i-1)/(1+beta(K_i-1))在端点处的符号，而不是K值是否全部在1的一侧
+ * （如K = {1e3, 0.5}且进料富含H2时K跨越1，但F(1) > 0）：
+ * - F(1) >= 0时不迭代，beta = 1（气相单相），返回PH_OK；所有K >= 1是其特例；
+ * - F(0) <= 0时不迭代，beta = 0（液相单相），返回PH_OK；所有K <= 1是其特例；
+ * - 否则F(0) > 0 > F(1)，根位于(0, 1)内，在(max(0, beta_min), min(1, beta_max))
+ *   内求根（beta_min = 1/(1-K_max)，beta_max = 1/(1-K_min)），无需截断；
+ *   需要保留超出[0, 1]的beta时使用ph_vle_solve_rachford_rice_negative。
+ *
+ * @param z 进料组成
+ * @param K K值
+ * @param beta 存储气相摩尔分数的指针（取值在[0, 1]内）
+ * @param iterations 存储迭代次数的指针（单相提前返回时为0，可为NULL）
+ * @return 错误代码
+ */
+PHErrorCode ph_vle_solve_rachford_rice_robust(const double *z, const double *K,
+                                             double *beta, int *iterations);
+
+/**
+ * @brief 求解负闪蒸Rachford-Rice方程（Whitson-Michelsen）
+ *
+ * beta在(1/(1-K_max), 1/(1-K_min))区间内求解，不截断到[0,1]；
+ * 收敛的beta<=0表示液相单相，beta>=1表示气相单相。
+ *
+ * @param z 进料组成
+ * @param K K值（须同时存在K>1和K<1的组分）
+ * @param beta 存储（可超出[0,1]的）气相摩尔分数的指针
+ * @return 错误代码（所有K >= 1或所有K <= 1时求解区间不存在，返回
+ *         PH_ERROR_INPUT_INCONSISTENT，beta不被修改）
+ */
+PHErrorCode ph_vle_solve_rachford_rice_negative(const double *z, const double *K, double *beta);
+
+/**
+ * @brief 根据负闪蒸的beta判定相态
+ * @param beta 负闪蒸得到的气相摩尔分数
+ * @param n_phases 存储相数的指针（1或2）
+ * @param is_vapor 单相时存储是否为气相（1表示气相，0表示液相；两相时为-1）
+ * @return 错误代码
+ */
+PHErrorCode ph_vle_classify_negative_flash(double beta, int *n_phases, int *is_vapor);
+
+/**
+ * @brief 批量求解多组独立(z, K)的Rachford-Rice方程（向量化）
+ *
+ * 按ph_simd_get_level选择的向量宽度逐块处理，每个通道独立进行Newton迭代，
+ * 已满足TOL_RR的通道被屏蔽不再更新，其余通道继续迭代至MAX_ITER_RR；
+ * 收敛判据与ph_vle_solve_rachford_rice相同。
+ *
+ * @param n 方程组数
+ * @param z_soa 进料组成: z_soa[i * n + k] 为第k组组分i的摩尔分数
+ * @param K_soa K值，布局同z_soa
+ * @param beta 存储气相摩尔分数的数组，长度n
+ * @param lane_status 每组的错误代码，长度n（可为NULL）
+ * @return 错误代码（全部收敛返回PH_OK，否则返回PH_ERROR_ALGORITHM_RACHFORD_RICE）
+ */
+PHErrorCode ph_vle_solve_rachford_rice_batch(int n, const double *z_soa, const double *K_soa,
+                                            double *beta, PHErrorCode *lane_status);
+
 /**
  * @brief 根据beta和K值计算液相和气相组成
  * @param z 进料组成
@@ -78,8 +189,144 @@ PHErrorCode ph_vle_tpd_analysis(double T, double P, const double *z,
                                const PREOSParams *params, const FlashOptions *options,
                                int *is_unstable, double *trial_comp);
 
+/**
+ * @brief 以给定种子组成优先的TPD稳定性分析
+ *
+ * seed_comp非NULL时先以其为试探组成迭代，再按枚举顺序迭代其余试探组成；
+ * 任一试探的TPD小于-TOL_TPD时判定不稳定并停止，稳定判据与ph_vle_tpd_analysis
+ * 相同（seed_comp为NULL时结果与ph_vle_tpd_analysis逐位一致）。同时输出
+ * 已计算试探中TPD最小的驻点及其TPD值，供稳定性缓存推算跳过区间。
+ *
+ * @param T 温度 [K]
+ * @param P 压力 [Pa]
+ * @param z 进料组成
+ * @param params PR状态方程参数
+ * @param options 闪蒸计算选项
+ * @param seed_comp 优先试探的组成（可为NULL）
+ * @param is_unstable 存储稳定性结果的指针（1表示不稳定，0表示稳定）
+ * @param trial_comp 如不稳定，存储试验组成的数组
+ * @param tpd_min 存储已计算试探中最小TPD值的指针
+ * @param stationary_point 存储对应驻点组成的数组 [NC]
+ * @return 错误代码
+ */
+PHErrorCode ph_vle_tpd_analysis_seeded(double T, double P, const double *z,
+                                      const PREOSParams *params, const FlashOptions *options,
+                                      const double *seed_comp, int *is_unstable,
+                                      double *trial_comp, double *tpd_min,
+                                      double *stationary_point);
+
+/**
+ * @brief 初始化TPD试探统计（顺序为枚举默认顺序）
+ * @param stats TPD试探统计
+ */
+void ph_vle_tpd_stats_init(PHTPDTrialStats *stats);
+
+/**
+ * @brief 按成功率(wins/attempts)降序重排试探顺序
+ * @param stats TPD试探统计
+ */
+void ph_vle_tpd_stats_update_order(PHTPDTrialStats *stats);
+
+/**
+ * @brief 按成功率顺序进行TPD稳定性分析，出现不稳定试探即停止搜索
+ *
+ * 按stats->order依次迭代试探组成，任一试探的TPD小于-TOL_TPD时即判定不稳定
+ * 并停止按该顺序的搜索；全部试探均非负才判定稳定，稳定性判据与
+ * ph_vle_tpd_analysis相同。结束时更新stats中的尝试和成功计数。
+ *
+ * 判定不稳定时，输出的种子（trial_comp和seed_trial）为按当前顺序首个判定
+ * 不稳定的试探，不补算排在其前面的试探，因此不稳定进料的成本随顺序改善而下降；
+ * 稳定进料仍须计算全部试探才能判定稳定，成本与顺序无关。
+ *
+ * 种子只作为等温闪蒸逐次替代的K初值，稳定性判定本身与顺序无关；不同种子
+ * 收敛到的相分率和组成在收敛容差（TOL_K_VALUE、TOL_FUGACITY）内一致，但不
+ * 逐位相同。stats为NULL时按枚举顺序，结果确定且与ph_vle_tpd_analysis一致。
+ *
+ * @param T 温度 [K]
+ * @param P 压力 [Pa]
+ * @param z 进料组成
+ * @param params PR状态方程参数
+ * @param options 闪蒸计算选项
+ * @param stats TPD试探统计（可为NULL，此时使用默认顺序）
+ * @param is_unstable 存储稳定性结果的指针（1表示不稳定，0表示稳定）
+ * @param trial_comp 如不稳定，存储种子试探的驻点组成的数组
+ * @param seed_trial 存储种子试探类型的指针（按当前顺序首个不稳定试探；稳定时为-1，可为NULL）
+ * @return 错误代码
+ */
+PHErrorCode ph_vle_tpd_analysis_ordered(double T, double P, const double *z,
+                                       const PREOSParams *params, const FlashOptions *options,
+                                       PHTPDTrialStats *stats, int *is_unstable,
+                                       double *trial_comp, int *seed_trial);
+
+/**
+ * @brief 清空稳定性分析缓存
+ * @param cache 稳定性分析缓存
+ */
+void ph_vle_stability_cache_reset(PHStabilityCache *cache);
+
+/**
+ * @brief 判断是否需要重新进行稳定性分析
+ *
+ * - 缓存无效，或相数相同的连续完整分析少于两次(n_agree < 2)时需要重新分析；
+ *   单次分析得不到dtpd_dT，据此外推的区间（每单位裕量约±1/TOL_STABILITY_TPD_SLOPE
+ *   = ±100 K）过宽，可能漏掉区间内出现的新相；
+ * - 两相状态(n_phases == 2)：仅当beta与0或1的距离小于TOL_STABILITY_BETA
+ *   （某一相即将消失）时重新分析，不检查温度；
+ * - 单相状态(n_phases == 1)：beta不参与判断（单相时beta必为0或1），
+ *   仅当T超出由TPD裕量推算的[T_lower, T_upper]时重新分析。
+ *
+ * 单相跳过区间在每次完整TPD分析后按驻点的TPD裕量重新计算：
+ *   margin  = tpd_min - TOL_STABILITY_TPD_MARGIN（margin <= 0时区间为空，每步重新分析）
+ *   T_upper = T_last + margin / max(-dtpd_dT, TOL_STABILITY_TPD_SLOPE)
+ *   T_lower = T_last - margin / max( dtpd_dT, TOL_STABILITY_TPD_SLOPE)
+ * 其中dtpd_dT由相数未变的相邻两次分析的驻点TPD差分得到（n_agree >= 2后才计算区间）。远离相包络时
+ * 裕量大，区间随之变宽，外循环单调移动的温度步通常仍落在区间内；
+ * 接近相包络时裕量减小，区间收缩，从而在跨越相边界前重新分析。
+ *
+ * @param cache 稳定性分析缓存
+ * @param T 温度 [K]
+ * @param beta 当前气相摩尔分数
+ * @return 需要重新分析返回1，否则返回0
+ */
+int ph_vle_stability_needs_retest(const PHStabilityCache *cache, double T, double beta);
+
+/**
+ * @brief 带缓存的TPD稳定性分析
+ *
+ * 不需要重新分析（ph_vle_stability_needs_retest返回0）时直接由缓存给出结果；
+ * 否则以缓存驻点为seed_comp调用ph_vle_tpd_analysis_seeded（缓存无效时seed_comp
+ * 为NULL），更新驻点、tpd_min和相数：相数与上次相同时n_agree加1并由两次驻点TPD
+ * 差分更新dtpd_dT，否则n_agree置1；n_agree >= 2时按上述规则重新计算单相跳过区间。
+ *
+ * @param T 温度 [K]
+ * @param P 压力 [Pa]
+ * @param z 进料组成
+ * @param params PR状态方程参数
+ * @param options 闪蒸计算选项
+ * @param beta 当前气相摩尔分数
+ * @param cache 稳定性分析缓存
+ * @param is_unstable 存储稳定性结果的指针（1表示不稳定，0表示稳定）
+ * @param trial_comp 如不稳定，存储试验组成的数组
+ * @return 错误代码
+ */
+PHErrorCode ph_vle_tpd_analysis_cached(double T, double P, const double *z,
+                                      const PREOSParams *params, const FlashOptions *options,
+                                      double beta, PHStabilityCache *cache,
+                                      int *is_unstable, double *trial_comp);
+
 /**
  * @brief 在给定T,P下进行等温闪蒸计算
+ * @note 每次迭代通过PH_TRACE调用options->trace_callback
+ * @note options->use_vle_newton开启时，逐次替代残差小于切换阈值后转入
+ *       ph_vle_newton_ln_k；两阶段迭代次数分别写入state->vle_ss_iterations
+ *       和state->vle_newton_iterations
+ * @note options->use_negative_flash开启时，逐次替代中的Rachford-Rice使用
+ *       ph_vle_solve_rachford_rice_negative，由收敛beta的符号判定单相状态，
+ *       仅当beta靠近0或1（|beta| < TOL_NEGATIVE_FLASH_BETA或
+ *       |beta - 1| < TOL_NEGATIVE_FLASH_BETA，即相包络附近）时才调用
+ *       ph_vle_check_single_phase和TPD分析。某次迭代的K值全部 >= 1或全部 <= 1时
+ *       不调用负闪蒸求解，分别按气相或液相单相候选处理（beta = 1或0），
+ *       并同样调用ph_vle_check_single_phase和TPD分析确认
  * @param T 温度 [K]
  * @param P 压力 [Pa]
  * @param z 进料组成
@@ -94,6 +341,75 @@ PHErrorCode ph_vle_isothermal_flash(double T, double P, const double *z,
                                    const CriticalProps critical_props[NC],
                                    StateProperties *state);
 
+/**
+ * @brief 带稳定性缓存的等温闪蒸计算
+ *
+ * 与ph_vle_isothermal_flash相同，但稳定性分析可复用缓存并按试探统计排序：
+ * - cache非NULL、options->use_stability_skip开启且缓存有效时使用
+ *   ph_vle_tpd_analysis_cached，cache在同一P-H闪蒸的各次调用间保留
+ *   （由ph_flash_temperature_iteration持有）；
+ * - 否则tpd_stats非NULL时使用ph_vle_tpd_analysis_ordered并更新其计数，
+ *   为NULL时使用ph_vle_tpd_analysis。
+ * cache和tpd_stats均为NULL时与ph_vle_isothermal_flash逐位一致。
+ *
+ * @param T 温度 [K]
+ * @param P 压力 [Pa]
+ * @param z 进料组成
+ * @param params PR状态方程参数
+ * @param options 闪蒸计算选项
+ * @param critical_props 临界性质数组
+ * @param cache 稳定性分析缓存（可为NULL）
+ * @param tpd_stats TPD试探统计（可为NULL，此时按枚举顺序）
+ * @param state 存储状态属性的结构指针
+ * @return 错误代码
+ */
+PHErrorCode ph_vle_isothermal_flash_cached(double T, double P, const double *z,
+                                          PREOSParams *params, const FlashOptions *options,
+                                          const CriticalProps critical_props[NC],
+                                          PHStabilityCache *cache,
+                                          PHTPDTrialStats *tpd_stats,
+                                          StateProperties *state);
+
+/**
+ * @brief 批量等温闪蒸计算
+ *
+ * 各点的逐次替代迭代同步推进，每轮的Rachford-Rice求解使用
+ * ph_vle_solve_rachford_rice_batch，压缩因子使用ph_eos_solve_cubic_batch；
+ * 已收敛的点退出后续轮次。
+ *
+ * @param n_points 计算点数
+ * @param T 温度数组 [K]
+ * @param P 压力数组 [Pa]
+ * @param z_soa 进料组成: z_soa[i * n_points + k] 为第k点组分i的摩尔分数
+ * @param options 闪蒸计算选项
+ * @param critical_props 临界性质数组
+ * @param results 结果数组，长度n_points（每点状态写入results[k].status）
+ * @return 错误代码（全部点成功返回PH_OK，否则返回首个失败点的错误代码）
+ */
+PHErrorCode ph_vle_isothermal_flash_batch(int n_points, const double *T, const double *P,
+                                         const double *z_soa, const FlashOptions *options,
+                                         const CriticalProps critical_props[NC],
+                                         StateProperties *results);
+
+/**
+ * @brief 以ln K为变量的二阶(Newton)等温闪蒸（Michelsen方法）
+ *
+ * 从state中的K、beta、x、y出发，以Gibbs自由能最小化的Hessian
+ * （由ph_eos_calc_fugacity_derivatives的摩尔数导数解析构造）求解ln K更新，
+ * Newton步使Gibbs自由能上升时回退为逐次替代步。
+ *
+ * @param T 温度 [K]
+ * @param P 压力 [Pa]
+ * @param z 进料组成
+ * @param params PR状态方程参数
+ * @param state 状态属性（输入为逐次替代阶段结果，输出为收敛解）
+ * @param iterations 存储Newton迭代次数的指针
+ * @return 错误代码
+ */
+PHErrorCode ph_vle_newton_ln_k(double T, double P, const double *z,
+                              PREOSParams *params, StateProperties *state,
+                              int *iterations);
+
 /**
  * @brief 检查组成是否为单相
  * @param T 温度 [K]
@@ -128,4 +444,20 @@ PHErrorCode ph_vle_estimate_k_from_tpd(const double *z, const double *trial_comp
 PHErrorCode ph_vle_anderson_acceleration(double **k_history, double **residual_history,
                                         int k_size, int m, int iter, double *K_new);
 
+/**
+ * @brief 使用环形缓冲区Anderson实例对K值更新进行加速
+ *
+ * 与ph_vle_anderson_acceleration作用相同，但历史保存在AndersonState的固定
+ * 环形缓冲区中，最小二乘问题由增量QR分解求解，不需要调用方维护指针数组。
+ * 以ln K为加速变量，逐次替代给出的K_ss与K_current之差为残差。
+ *
+ * @param state Anderson加速器实例（每次等温闪蒸开始时重置）
+ * @param K_current 当前K值
+ * @param K_ss 逐次替代更新后的K值
+ * @param K_new 存储加速后K值的数组
+ * @return 错误代码
+ */
+PHErrorCode ph_vle_anderson_update(AndersonState *state, const double *K_current,
+                                  const double *K_ss, double *K_new);
+
 #endif /* PH_VLE_H */
\ No newline at end of file
@@ -0,0 +1,70 @@
+/**
+ * @file check_nomalloc.c
+ * @brief 运行时检查稳态闪蒸路径不分配堆内存（make check-nomalloc调用）
+ *
+ * 预热一轮（创建线程工作区等一次性分配）后重复同一组闪蒸，
+ * 要求ph_malloc_count不变。只统计预热时成功的点，错误路径（错误链）的
+ * 分配不计入稳态路径。
+ */
+
+#include <stdio.h>
+#include "ph_flash.h"
+#include "ph_utils.h"
+
+#define CHECK_N_P 3
+#define CHECK_N_H 5
+#define CHECK_REPEATS 3
+
+int main(void) {
+    static const double z[NC] = {0.60, 0.20, 0.01, 0.15, 0.04};
+    static const double P[CHECK_N_P] = {1.0e5, 2.0e6, 1.5e7};
+    static const double H[CHECK_N_H] = {-40000.0, -20000.0, -5000.0, 0.0, 5000.0};
+    int ok[CHECK_N_P][CHECK_N_H];
+    FlashOptions options;
+    PHFlashContext *ctx = NULL;
+    StateProperties state;
+    long count_before;
+    long count_after;
+    int n_ok = 0;
+    int i, j, r;
+
+    if (ph_flash_init_options(&options) != PH_OK ||
+        ph_flash_context_create(&options, &ctx) != PH_OK) {
+        fprintf(stderr, "check_nomalloc: context setup failed\n");
+        return 1;
+    }
+
+    /* 预热：一次性分配在此发生，并记录可收敛的点 */
+    for (i = 0; i < CHECK_N_P; i++) {
+        for (j = 0; j < CHECK_N_H; j++) {
+            ok[i][j] = (ph_flash_calculate_ctx(ctx, z, P[i], H[j], &state) == PH_OK);
+            n_ok += ok[i][j];
+        }
+    }
+    if (n_ok == 0) {
+        fprintf(stderr, "check_nomalloc: no converged warm-up point\n");
+        ph_flash_context_destroy(&ctx);
+        return 1;
+    }
+
+    count_before = ph_malloc_count();
+    for (r = 0; r < CHECK_REPEATS; r++) {
+        for (i = 0; i < CHECK_N_P; i++) {
+            for (j = 0; j < CHECK_N_H; j++) {
+                if (ok[i][j]) {
+                    ph_flash_calculate_ctx(ctx, z, P[i], H[j], &state);
+                }
+            }
+        }
+    }
+    count_after = ph_malloc_count();
+    ph_flash_context_destroy(&ctx);
+
+    if (count_after != count_before) {
+        fprintf(stderr, "check_nomalloc: %ld heap allocations in %d steady-state flashes\n",
+                count_after - count_before, n_ok * CHECK_REPEATS);
+        return 1;
+    }
+    printf("check_nomalloc: %d steady-state flashes, no heap allocation\n", n_ok * CHECK_REPEATS);
+    return 0;
+}